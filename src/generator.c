@@ -7,7 +7,8 @@
  * 
  * The generator program takes a graph as input. The program repeatedly generates a random solution
  * to the problem as described on the first page and writes its result to the circular buffer. It repeats this
- * procedure until it is notified by the supervisor to terminate.
+ * procedure until it is notified by the supervisor to terminate. Solutions removing more than MAX_RESULT_EDGES
+ * edges are not written, so on graphs where no such solution is found the supervisor reports nothing.
  *
  **/
 
@@ -98,8 +99,8 @@ int main(int argc, const char **argv)
 
         //restore original state
         memcpy(*adj_mat_buffer, *g.adj_mat, g.num_vertices * g.num_vertices);
-        memset(&rs.edges, 0, sizeof(rs.edges));
-        rs.num_edges = 0;
+        memset(&rs, 0, sizeof(rs));
+        int num_conflicts = 0;
 
         //iterate over adjacency matrix and check for same color of two connected vertices
         for (size_t i = 0; i < g.num_vertices; i++)
@@ -117,10 +118,23 @@ int main(int argc, const char **argv)
 
                     if (rs.num_edges < MAX_RESULT_EDGES)
                         rs.edges[rs.num_edges++] = ENCODE(i, j);
+                    num_conflicts++;
                 }
             }
         }
 
+        //a truncated edge list would not match the coloring, so such solutions are not written
+        if (num_conflicts > MAX_RESULT_EDGES)
+            continue;
+
+        //attach the coloring packed with 2 bits per vertex, so the supervisor can verify the solution
+        if (g.num_vertices <= MAX_VERTICES)
+        {
+            rs.num_vertices = g.num_vertices;
+            for (size_t i = 0; i < g.num_vertices; i++)
+                PACK_COLOR(rs.colors, i, g.vertices[i]);
+        }
+
         //write to shared mem
         sem_wait(sem_wmutex);
         if (shm->state == 1)
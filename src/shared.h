@@ -20,6 +20,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <errno.h>
+#include <stdint.h>
 #include <semaphore.h>
 
 #define SHM_NAME "/11775823_shm"                /*!< the name of the shared memory region used by the supervisor and generator */
@@ -31,15 +32,22 @@
 #define PERM_OWNER_R (0400)                     /*!< read only permission */
 #define MAX_RESULT_EDGES (8)                    /*!< maximum number of removed edges to be written to the ring buffer */
 #define CIRCULAR_BUFFER_SIZE (100)              /*!< size of the ringbuffer as elements of type rset */
+#define MAX_VERTICES (256)                      /*!< maximum number of vertices a coloring can be attached for, bounded by DECODE_V */
+#define COLOR_BYTES ((MAX_VERTICES + 3) / 4)    /*!< size of a coloring packed with 2 bits per vertex */
 
 #define DECODE_U(val) (val >> 16)               /*!< parses the first vertex of a single edge */
 #define DECODE_V(val) (val & 255)               /*!< parses the second vertex of a single edge */
 #define ENCODE(u, v) (((int16_t)u << 16) | v)   /*!< encodes two 16 bit vertex indices as a single 32 bit integer */
 
+#define PACK_COLOR(buf, i, c) ((buf)[(i) >> 2] |= (uint8_t)((c) << (((i) & 3) << 1)))  /*!< stores color c of vertex i in a zeroed packed coloring */
+#define UNPACK_COLOR(buf, i) (((buf)[(i) >> 2] >> (((i) & 3) << 1)) & 3)              /*!< reads the color of vertex i from a packed coloring */
+
 typedef struct rset
 {
     int num_edges;                              /*!< number of edges the result set holds */
     int32_t edges[MAX_RESULT_EDGES];            /*!< an array that holds the edges removed from the graph */
+    int num_vertices;                           /*!< number of vertices in colors, 0 if no coloring is attached */
+    uint8_t colors[COLOR_BYTES];                /*!< the full coloring the edges were derived from, 2 bits per vertex */
 } rset_t;                                       /*!< result set holds the removed edges of a graph to be written to the ring buffer */
 
 typedef struct shm
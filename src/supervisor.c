@@ -7,15 +7,22 @@
  * 
  * The supervisor sets up the shared memory and the semaphores and initializes the circular buffer required
  * for the communication with the generators. It then waits for the generators to write solutions to the
- * circular buffer.
+ * circular buffer. If the graph is passed as arguments, every improving solution is verified against it
+ * together with the coloring attached by the generator before it is reported, and the verified coloring
+ * is printed. Without the graph only the removed edges are checked against the coloring, so solutions
+ * are reported as before and no coloring is printed.
  *
  **/
 
 #include <signal.h>
 #include <stdbool.h>
 #include <limits.h>
+#include <stdarg.h>
+#include <poll.h>
 #include "shared.h"
 
+#define OUT_BUFFER_SIZE (4096)                  /*!< size of the buffer holding output not yet written to stdout */
+
 typedef struct sigaction sigaction_t;           /*!< used for registering a signal callback function */
 
 static volatile bool should_terminate = false;  /*!< when set via signal callback, the supervisor advises generators to terminate and terminates itself */
@@ -24,18 +31,30 @@ static sem_t *sem_free = NULL;                  /*!< pointer to the semaphore tr
 static sem_t *sem_used = NULL;                  /*!< pointer to the semaphore tracking the used space in the ring buffer */
 static sem_t *sem_wmutex = NULL;                /*!< pointer to the semaphore used for mutex-access to the write end of the ring buffer */
 static shm_t *shm = NULL;                       /*!< pointer to the shared memory */
+static int32_t *graph_edges = NULL;             /*!< the encoded edges of the graph passed as arguments, used for verification */
+static int graph_num_edges = 0;                 /*!< number of edges in graph_edges, 0 if no graph was passed */
+static int graph_num_vertices = 0;              /*!< number of vertices of the graph passed as arguments */
+static char out_buf[OUT_BUFFER_SIZE];           /*!< output waiting to be written to stdout */
+static size_t out_len = 0;                      /*!< number of bytes used in out_buf */
 
 static void handle_signal(int);
 static void exit_error(const char *);
 static void create_shared_mem(shm_t **const);
 static void create_semaphores(sem_t **const, sem_t **const, sem_t **const);
 static void init_signal_handling(sigaction_t *const);
+static void init_graph(const char **);
+static bool has_edge(const int32_t *, int, int32_t);
+static bool verify_solution(const rset_t *const);
+static void print_solution(const rset_t *const);
+static void out_printf(const char *, ...);
+static int out_flush(bool);
 static void free_resources(void);
 
 /**
  * Main entry point of the supervisor program
  * @brief This function sets up necessary resources, e.g signal handling,
- * shared memory, semaphores and reads the result data out of the ring buffer
+ * shared memory, semaphores and reads the result data out of the ring buffer.
+ * Each wakeup drains all filled slots before they are handed back to the generators.
  * @param[in]  argc     argument count
  * @param[in]  argv     argument vector
  * @returns returns     EXIT_SUCCESS
@@ -45,6 +64,7 @@ static void free_resources(void);
  * @details global variables: sem_used
  * @details global variables: sem_wmutex
  * @details global variables: shm
+ * @details global variables: out_buf
  */
 int main(int argc, const char **argv)
 {
@@ -57,12 +77,9 @@ int main(int argc, const char **argv)
         exit(EXIT_FAILURE);
     }
 
-    //program must be executed without any options or arguments per synopsis
-    if (argc != 1)
-    {
-        fprintf(stderr, "[%s]: correct usage: supervisor\n", pgrm_name);
-        exit_error("invalid number of arguments");
-    }
+    //the edges of the graph are optional and only used for verifying solutions
+    if (argc > 1)
+        init_graph(argv + 1);
 
     //signal handler is executed whenever SIGINT or SIGTERM occurs
     sigaction_t sa;
@@ -77,11 +94,13 @@ int main(int argc, const char **argv)
     create_semaphores(&sem_free, &sem_used, &sem_wmutex);
     
     int read_pos = 0;
+    unsigned long num_rejected = 0;
+    bool solved = false;
     rset_t best_rset;
     best_rset.num_edges = INT_MAX;
 
     //main loop
-    while (!should_terminate)
+    while (!should_terminate && !solved)
     {
         if (sem_wait(sem_used) < 0)
         {
@@ -90,39 +109,58 @@ int main(int argc, const char **argv)
             exit_error("sem_wait failed");
         }
 
-        rset_t cur_rset = shm->data[read_pos];
+        //take every further slot already written without blocking again
+        int batch = 1;
+        while (batch < CIRCULAR_BUFFER_SIZE && sem_trywait(sem_used) == 0)
+            batch++;
 
-        //graph is acyclic, no edges need to be removed
-        if (cur_rset.num_edges == 0)
+        for (int i = 0; i < batch && !solved; i++)
         {
-            printf("The graph is 3-colorable!\n");
-            shm->state = 1;
-            break;
-        }
+            const rset_t *cur_rset = &shm->data[read_pos];
+            read_pos = (read_pos + 1) % CIRCULAR_BUFFER_SIZE;
 
-        //print better solutions
-        if (cur_rset.num_edges < best_rset.num_edges)
-        {
-            best_rset = cur_rset;
-            printf("Solution with %d edges: ", best_rset.num_edges);
+            //only solutions better than the current best are copied and verified
+            if (cur_rset->num_edges >= best_rset.num_edges)
+                continue;
 
-            for (size_t i = 0; i < best_rset.num_edges; i++)
+            rset_t cand_rset = *cur_rset;
+            if (!verify_solution(&cand_rset))
             {
-                int u = DECODE_U(best_rset.edges[i]);
-                int v = DECODE_V(best_rset.edges[i]);
-                printf("%d-%d ", u, v);
+                num_rejected++;
+                continue;
+            }
+
+            best_rset = cand_rset;
+            print_solution(&best_rset);
+
+            //graph is acyclic, no edges need to be removed
+            if (best_rset.num_edges == 0)
+            {
+                shm->state = 1;
+                solved = true;
             }
-            printf("\n");
         }
 
-        sem_post(sem_free);
-        read_pos = (read_pos + 1) % CIRCULAR_BUFFER_SIZE;
+        for (int i = 0; i < batch; i++)
+            sem_post(sem_free);
+
+        if (out_flush(false) < 0)
+            exit_error("writing output failed");
     }
 
     sem_post(sem_free);
     shm->state = 1;
 
-    printf("Supervisor exits gracefully\n");
+    if (num_rejected > 0)
+        out_printf("Rejected %lu invalid solutions\n", num_rejected);
+
+    //generators only write solutions removing at most MAX_RESULT_EDGES edges
+    if (best_rset.num_edges == INT_MAX)
+        out_printf("No solution with at most %d edges found\n", MAX_RESULT_EDGES);
+
+    out_printf("Supervisor exits gracefully\n");
+    if (out_flush(true) < 0)
+        exit_error("writing output failed");
     return EXIT_SUCCESS;
 }
 
@@ -209,12 +247,282 @@ static void init_signal_handling(sigaction_t *const sa)
         exit_error("sigaction failed");
 }
 
+/**
+ * initialize graph
+ * @brief This function parses the edge data passed as program arguments and
+ * stores the encoded edges and the number of vertices for verifying solutions
+ * @param[in]   pedges  pointer to the edges passed as program arguments
+ * @details global variables: graph_edges
+ * @details global variables: graph_num_edges
+ * @details global variables: graph_num_vertices
+ */
+static void init_graph(const char **pedges)
+{
+    int num_edges = 0;
+    while (pedges[num_edges] != NULL)
+        num_edges++;
+
+    if ((graph_edges = malloc(num_edges * sizeof(int32_t))) == NULL)
+        exit_error("malloc failed");
+
+    for (int i = 0; i < num_edges; i++)
+    {
+        char *end;
+        //for error checking on strtol
+        errno = 0;
+        long u = strtol(pedges[i], &end, 10);
+
+        //an edge must be two numbers separated by a single '-', e.g. "0-1"
+        const char *vstr = end + 1;
+        bool valid = end != pedges[i] && *end == '-';
+        long v = valid ? strtol(vstr, &end, 10) : 0;
+        valid = valid && end != vstr && *end == '\0' && errno == 0;
+
+        if (!valid)
+        {
+            fprintf(stderr, "[%s]: correct usage: supervisor [EDGE1...]\n", pgrm_name);
+            exit_error("edge parsing error");
+        }
+
+        if (u < 0 || v < 0 || u >= MAX_VERTICES || v >= MAX_VERTICES)
+        {
+            fprintf(stderr, "[%s]: correct usage: supervisor [EDGE1...]\n", pgrm_name);
+            exit_error("vertex index out of range");
+        }
+
+        if (u >= graph_num_vertices || v >= graph_num_vertices)
+            graph_num_vertices = (u > v ? u : v) + 1;
+
+        graph_edges[i] = ENCODE(u, v);
+    }
+
+    graph_num_edges = num_edges;
+}
+
+/**
+ * search an edge
+ * @brief This function checks whether an edge is contained in a list of edges. Edges are matched in
+ * the direction they were encoded, as the generator removes u-v and v-u as separate edges
+ * @param[in]   edges       the encoded edges to be searched
+ * @param[in]   num_edges   number of edges in the list
+ * @param[in]   e           the encoded edge to search for
+ * @returns returns         true if the edge was found
+ */
+static bool has_edge(const int32_t *edges, int num_edges, int32_t e)
+{
+    for (int i = 0; i < num_edges; i++)
+    {
+        if (edges[i] == e)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * verify a solution
+ * @brief This function checks the removed edges of a result set against its attached coloring
+ * and, if a graph was passed, against the graph: the coloring is then required, every removed edge
+ * must be part of the graph and every edge of the graph connecting two vertices of the same color
+ * must be removed. Without a graph a result set may come without a coloring. Since the
+ * number of removed edges is bounded by MAX_RESULT_EDGES, this takes O(E) time.
+ * @param[in]   rs  the result set to be verified
+ * @returns returns true if the result set is a valid solution
+ * @details global variables: graph_edges
+ * @details global variables: graph_num_edges
+ * @details global variables: graph_num_vertices
+ */
+static bool verify_solution(const rset_t *const rs)
+{
+    if (rs->num_edges < 0 || rs->num_edges > MAX_RESULT_EDGES)
+        return false;
+
+    if (rs->num_vertices < 0 || rs->num_vertices > MAX_VERTICES)
+        return false;
+
+    //generators attach a coloring for every graph the supervisor accepts, so it must be present and belong to the same graph
+    if (graph_num_edges > 0 && rs->num_vertices != graph_num_vertices)
+        return false;
+
+    for (int i = 0; i < rs->num_vertices; i++)
+    {
+        if (UNPACK_COLOR(rs->colors, i) > 2)
+            return false;
+    }
+
+    for (int i = 0; i < rs->num_edges; i++)
+    {
+        int u = DECODE_U(rs->edges[i]);
+        int v = DECODE_V(rs->edges[i]);
+
+        //reject negative indices and bits ignored by DECODE_V before using them as indices
+        if (u < 0 || v < 0 || ENCODE(u, v) != rs->edges[i])
+            return false;
+
+        if (graph_num_edges > 0 && !has_edge(graph_edges, graph_num_edges, rs->edges[i]))
+            return false;
+
+        if (rs->num_vertices == 0)
+            continue;
+
+        if (u >= rs->num_vertices || v >= rs->num_vertices)
+            return false;
+
+        if (UNPACK_COLOR(rs->colors, u) != UNPACK_COLOR(rs->colors, v))
+            return false;
+    }
+
+    //only possible without a graph, so there are no remaining edges to be checked
+    if (rs->num_vertices == 0)
+        return true;
+
+    for (int i = 0; i < graph_num_edges; i++)
+    {
+        int u = DECODE_U(graph_edges[i]);
+        int v = DECODE_V(graph_edges[i]);
+
+        if (UNPACK_COLOR(rs->colors, u) == UNPACK_COLOR(rs->colors, v) && !has_edge(rs->edges, rs->num_edges, graph_edges[i]))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * print a solution
+ * @brief This function writes the removed edges of a result set to the output buffer, followed by
+ * its coloring as one digit per vertex in index order, e.g. "Coloring: 0120". The coloring is only
+ * printed if it was verified against the graph passed as arguments
+ * @param[in]   rs  the result set to be printed
+ * @details global variables: graph_num_edges
+ */
+static void print_solution(const rset_t *const rs)
+{
+    if (rs->num_edges == 0)
+    {
+        out_printf("The graph is 3-colorable!\n");
+    }
+    else
+    {
+        out_printf("Solution with %d edges: ", rs->num_edges);
+
+        for (int i = 0; i < rs->num_edges; i++)
+            out_printf("%d-%d ", DECODE_U(rs->edges[i]), DECODE_V(rs->edges[i]));
+
+        out_printf("\n");
+    }
+
+    if (graph_num_edges > 0 && rs->num_vertices > 0)
+    {
+        char colors[MAX_VERTICES + 1];
+        for (int i = 0; i < rs->num_vertices; i++)
+            colors[i] = '0' + UNPACK_COLOR(rs->colors, i);
+        colors[rs->num_vertices] = '\0';
+
+        out_printf("Coloring: %s\n", colors);
+    }
+}
+
+/**
+ * buffered printf
+ * @brief This function formats the output into the output buffer, which is flushed
+ * blocking only if it runs out of space. Output that still does not fit is dropped
+ * @param[in]   fmt     the format string
+ * @details global variables: out_buf
+ * @details global variables: out_len
+ */
+static void out_printf(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(out_buf + out_len, sizeof(out_buf) - out_len, fmt, args);
+    va_end(args);
+
+    if (len < 0)
+        exit_error("vsnprintf failed");
+
+    if (len >= sizeof(out_buf) - out_len)
+    {
+        if (out_flush(true) < 0)
+            exit_error("writing output failed");
+
+        va_start(args, fmt);
+        len = vsnprintf(out_buf + out_len, sizeof(out_buf) - out_len, fmt, args);
+        va_end(args);
+
+        if (len < 0)
+            exit_error("vsnprintf failed");
+
+        //the flush stops early when terminating, so the buffer may still be full
+        if (len >= sizeof(out_buf) - out_len)
+            return;
+    }
+
+    out_len += len;
+}
+
+/**
+ * flush the output buffer
+ * @brief This function writes the output buffer to stdout. The flags of stdout are shared with
+ * the shell and the generators, so instead of setting O_NONBLOCK it only writes chunks of at
+ * most PIPE_BUF bytes while poll reports stdout as writable. Once a signal requested termination it
+ * no longer waits, so a stalled reader cannot keep the supervisor from cleaning up
+ * @param[in]   block   whether to wait until the whole buffer is written
+ * @returns returns     0 on success, -1 if poll or write failed with errno set
+ * @details global variables: out_buf
+ * @details global variables: out_len
+ * @details global variables: should_terminate
+ */
+static int out_flush(bool block)
+{
+    int ret = 0;
+    size_t written = 0;
+    struct pollfd pfd = { .fd = STDOUT_FILENO, .events = POLLOUT };
+
+    while (written < out_len)
+    {
+        int ready = poll(&pfd, 1, block && !should_terminate ? -1 : 0);
+        if (ready < 0 && errno == EINTR && !should_terminate)
+            continue;
+        if (ready < 0)
+        {
+            ret = -1;
+            break;
+        }
+        if (ready == 0)
+            break;
+
+        size_t chunk = out_len - written < PIPE_BUF ? out_len - written : PIPE_BUF;
+        ssize_t n = write(STDOUT_FILENO, out_buf + written, chunk);
+        if (n < 0 && ((errno == EINTR && !should_terminate) || errno == EAGAIN))
+            continue;
+        if (n < 0)
+        {
+            ret = -1;
+            break;
+        }
+
+        written += n;
+    }
+
+    memmove(out_buf, out_buf + written, out_len - written);
+    out_len -= written;
+    return ret;
+}
+
 /**
  * delete all resources used
  * @brief This function unregisters and deletes all allocated resources
  */
 static void free_resources(void)
 {
+    //best effort only, a stalled reader must not keep the supervisor from exiting
+    if (out_flush(false) < 0)
+        fprintf(stderr, "[%s]: writing output failed, Error: %s\n", pgrm_name, strerror(errno));
+
+    if (graph_edges != NULL) {
+        free(graph_edges);
+    }
+
     if (shm != NULL) {
         if (munmap(shm, sizeof(shm_t)) < 0)
             fprintf(stderr, "[%s]: munmmap failed, Error: %s\n", pgrm_name, strerror(errno));